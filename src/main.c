@@ -3,30 +3,40 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "unpack.h"
+#include "summary.h"
 
 int main(int argc, char *argv[]) {
     FILE *fp;
+    void (*process_file)(FILE *fp) = unpack_file;
+    int first_file_arg = 1;
 
-    if (argc <= 1) {
+    // --summary: print some statistics about the records instead of unpacking them
+    if (argc > 1 && strcmp(argv[1], "--summary") == 0) {
+        process_file = summarize_file;
+        first_file_arg = 2;
+    }
+
+    if (argc <= first_file_arg) {
         // like classic UNIX tools we proceed to read from standard input if no file was provided as argument
         fp = stdin;
-        unpack_file(fp);
+        process_file(fp);
 
         if (fp != NULL) {
             fclose(fp);
             fp = NULL;
         }
     } else {
-        for (int i = 1; i < argc; i++) {
+        for (int i = first_file_arg; i < argc; i++) {
             // again, like classic UNIX tools we do not print any output except if something goes wrong
             if ((fp = fopen(argv[i], "r")) == NULL) {
-                fprintf(stderr, "Cannot open file: %s", argv[1]);
+                fprintf(stderr, "Cannot open file: %s\n", argv[i]);
                 exit(EXIT_FAILURE);
             }
 
-            unpack_file(fp);
+            process_file(fp);
 
             if (fp != NULL) {
                 fclose(fp);
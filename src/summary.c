@@ -0,0 +1,475 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "util.h"
+#include "mem.h"
+#include "unpack.h"
+#include "summary.h"
+
+#define STDIO_BUFFER_SIZE (1 << 20)
+
+/* stdio ignores the size passed to setvbuf() unless we hand it a buffer of our own. Static, as it has to stay valid
+ * until the file gets closed (files are summarized one after another). */
+static char stdio_buffer[STDIO_BUFFER_SIZE];
+
+static int parse_number(const char *line, struct field_span span, uint64_t *number);
+
+static int is_timestamp(const char *line, struct field_span span);
+
+static int compare_timestamp(const char *line, struct field_span span, const char *timestamp);
+
+static void update_timestamp_range(const char *line, struct field_span span, char *timestamp_min, char *timestamp_max);
+
+static struct partition_summary *get_partition_summary(struct export_summary *summary, uint64_t partition);
+
+static void add_offset(struct partition_summary *partition_summary, uint64_t offset);
+
+static void insert_offset_run(struct partition_summary *partition_summary, size_t idx, uint64_t offset);
+
+static uint64_t hash_key(const char *line, struct field_span span);
+
+static void add_key(struct export_summary *summary, const char *line, struct field_span span);
+
+static double estimate_key_cardinality(const struct export_summary *summary);
+
+static size_t value_size_bucket(size_t value_size);
+
+static size_t value_size_percentile(const struct export_summary *summary, double percentile);
+
+/**
+ * Read a topic reader export file and print a summary about its records instead of unpacking them.
+ *
+ * Records are only scanned for the positions of their fields (see scan_record_fields()), neither fields nor lines are
+ * copied or allocated, and no files are written. This allows to answer questions about large exports (records per
+ * partition, offset gaps, timestamp range, number of distinct keys, value sizes) at about the speed we can read them.
+ */
+void summarize_file(FILE *fp) {
+    struct export_metadata metadata = {0};
+    struct export_summary summary;
+
+    memset(&summary, 0, sizeof(summary));
+
+    // we read sequentially through possibly multi GB files - a larger buffer saves us lots of read() calls
+    setvbuf(fp, stdio_buffer, _IOFBF, STDIO_BUFFER_SIZE);
+
+    read_export_file(fp, &metadata, summarize_record_line, &summary);
+
+    // metadata lines are read one after another, a missing timeTo means the export ended before line 5
+    exit_on_failure(metadata.time_to == NULL, "Failed to extract metadata, export has less than 5 lines.\n");
+
+    print_summary(&summary, &metadata);
+
+    free_export_metadata(&metadata);
+    for (size_t i = 0; i < summary.partitions_len; i++) {
+        FREE(summary.partitions[i].offset_runs);
+    }
+    FREE(summary.partitions);
+}
+
+void summarize_record_line(const char *line, size_t line_len, const struct export_metadata *metadata,
+                           void *context) {
+    struct export_summary *summary = context;
+    struct record_fields fields;
+    uint64_t partition = 0;
+    uint64_t offset = 0;
+
+    if (scan_record_fields(line, line_len, &fields) != 0
+        || parse_number(line, fields.partition, &partition) != 0
+        || parse_number(line, fields.offset, &offset) != 0) {
+        summary->skipped_lines++;
+        return;
+    }
+
+    struct partition_summary *partition_summary = get_partition_summary(summary, partition);
+
+    add_offset(partition_summary, offset);
+    partition_summary->records++;
+    summary->records++;
+
+    if (is_timestamp(line, fields.timestamp)) {
+        update_timestamp_range(line, fields.timestamp, partition_summary->timestamp_min,
+                               partition_summary->timestamp_max);
+        update_timestamp_range(line, fields.timestamp, summary->timestamp_min, summary->timestamp_max);
+    } else {
+        summary->invalid_timestamps++;
+    }
+
+    add_key(summary, line, fields.key);
+
+    const size_t value_size = fields.value.end - fields.value.start;
+    summary->value_sizes[value_size_bucket(value_size)]++;
+    if (value_size > summary->value_size_max) {
+        summary->value_size_max = value_size;
+    }
+}
+
+void print_summary(const struct export_summary *summary, const struct export_metadata *metadata) {
+    fprintf(stdout, "environment=[%s], topic=[%s], searchValue=[%s], timeFrom=[%s], timeTo=[%s]\n",
+            metadata->environment, metadata->topic, metadata->search_value, metadata->time_from, metadata->time_to
+    );
+
+    for (size_t i = 0; i < summary->partitions_len; i++) {
+        const struct partition_summary *partition_summary = &summary->partitions[i];
+        const struct offset_run *offset_runs = partition_summary->offset_runs;
+        const size_t offset_runs_len = partition_summary->offset_runs_len;
+
+        // every offset between two runs is one we didn't see
+        uint64_t missing_offsets = 0;
+        for (size_t run = 1; run < offset_runs_len; run++) {
+            missing_offsets += offset_runs[run].first - offset_runs[run - 1].last - 1;
+        }
+
+        fprintf(stdout,
+                "partition=[%llu], records=[%llu], offsets=[%llu..%llu], offset_gaps=[%zu], missing_offsets=[%llu], "
+                "duplicate_offsets=[%llu], timestamps=[%s..%s]\n",
+                (unsigned long long) partition_summary->partition,
+                (unsigned long long) partition_summary->records,
+                (unsigned long long) offset_runs[0].first,
+                (unsigned long long) offset_runs[offset_runs_len - 1].last,
+                offset_runs_len - 1,
+                (unsigned long long) missing_offsets,
+                (unsigned long long) partition_summary->duplicate_offsets,
+                partition_summary->timestamp_min,
+                partition_summary->timestamp_max
+        );
+    }
+
+    fprintf(stdout,
+            "total: partitions=[%zu], records=[%llu], skipped_lines=[%llu], invalid_timestamps=[%llu], timestamps=[%s..%s], "
+            "distinct_keys=[~%.0f], value_size=[p50=%zu, p90=%zu, p99=%zu, max=%zu]\n",
+            summary->partitions_len,
+            (unsigned long long) summary->records,
+            (unsigned long long) summary->skipped_lines,
+            (unsigned long long) summary->invalid_timestamps,
+            summary->timestamp_min,
+            summary->timestamp_max,
+            estimate_key_cardinality(summary),
+            value_size_percentile(summary, 50.0),
+            value_size_percentile(summary, 90.0),
+            value_size_percentile(summary, 99.0),
+            summary->value_size_max
+    );
+}
+
+/**
+ * Parses a field consisting of decimal digits only.
+ *
+ * @return 0 on success, 1 if the field is empty, contains anything but digits or does not fit into 64 bits
+ */
+static int parse_number(const char *line, struct field_span span, uint64_t *number) {
+    uint64_t result = 0;
+
+    if (span.start >= span.end) {
+        return 1;
+    }
+
+    for (size_t idx = span.start; idx < span.end; idx++) {
+        const unsigned char c = line[idx];
+        if (c < '0' || c > '9') {
+            return 1;
+        }
+        if (result > (UINT64_MAX - (c - '0')) / 10) {
+            return 1;
+        }
+        result = result * 10 + (c - '0');
+    }
+
+    *number = result;
+    return 0;
+}
+
+/**
+ * Checks whether a timestamp field starts like an ISO 8601 date time (DDDD-DD-DDT). Fields that don't are not taken
+ * into account for timestamp ranges, they would not compare meaningfully with real timestamps.
+ */
+static int is_timestamp(const char *line, struct field_span span) {
+    const char pattern[] = "DDDD-DD-DDT";
+    const size_t pattern_len = strlen(pattern);
+
+    if (span.end - span.start < pattern_len) {
+        return 0;
+    }
+
+    for (size_t idx = 0; idx < pattern_len; idx++) {
+        const unsigned char c = line[span.start + idx];
+        if (pattern[idx] == 'D' ? (c < '0' || c > '9') : c != pattern[idx]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Compares a timestamp field with a previously seen timestamp (like strcmp()). Timestamps are ISO 8601 formatted and
+ * thus can be compared char by char.
+ */
+static int compare_timestamp(const char *line, struct field_span span, const char *timestamp) {
+    const size_t field_len = span.end - span.start;
+    const size_t timestamp_len = strlen(timestamp);
+    const int result = memcmp(line + span.start, timestamp, field_len < timestamp_len ? field_len : timestamp_len);
+
+    if (result != 0) {
+        return result;
+    }
+    return (field_len > timestamp_len) - (field_len < timestamp_len);
+}
+
+static void update_timestamp_range(const char *line, struct field_span span, char *timestamp_min,
+                                   char *timestamp_max) {
+    size_t field_len = span.end - span.start;
+
+    // we do not expect timestamps this long - keep what fits
+    if (field_len >= TIMESTAMP_MAX_LEN) {
+        field_len = TIMESTAMP_MAX_LEN - 1;
+        span.end = span.start + field_len;
+    }
+
+    if (timestamp_min[0] == '\0' || compare_timestamp(line, span, timestamp_min) < 0) {
+        memcpy(timestamp_min, line + span.start, field_len);
+        timestamp_min[field_len] = '\0';
+    }
+    if (timestamp_max[0] == '\0' || compare_timestamp(line, span, timestamp_max) > 0) {
+        memcpy(timestamp_max, line + span.start, field_len);
+        timestamp_max[field_len] = '\0';
+    }
+}
+
+/**
+ * Returns the summary of the given partition. Partition summaries are kept sorted by partition number and looked up by
+ * binary search. Exports carry a handful of partitions, thus a new one has to be inserted a few times per export at
+ * most, not per record.
+ */
+static struct partition_summary *get_partition_summary(struct export_summary *summary, uint64_t partition) {
+    size_t low = 0;
+    size_t high = summary->partitions_len;
+
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (summary->partitions[middle].partition < partition) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low < summary->partitions_len && summary->partitions[low].partition == partition) {
+        return &summary->partitions[low];
+    }
+
+    if (summary->partitions_len == summary->partitions_capacity) {
+        const size_t partitions_capacity = summary->partitions_capacity < 16 ? 16 : summary->partitions_capacity * 2;
+
+        struct partition_summary *partitions = realloc(summary->partitions,
+                                                       sizeof(struct partition_summary) * partitions_capacity);
+        if (partitions == NULL) {
+            fprintf(stderr, "Failed to allocate memory for partition summaries\n");
+            exit(EXIT_FAILURE);
+        }
+
+        summary->partitions = partitions;
+        summary->partitions_capacity = partitions_capacity;
+    }
+
+    memmove(&summary->partitions[low + 1], &summary->partitions[low],
+            sizeof(struct partition_summary) * (summary->partitions_len - low));
+    summary->partitions_len++;
+
+    memset(&summary->partitions[low], 0, sizeof(struct partition_summary));
+    summary->partitions[low].partition = partition;
+
+    return &summary->partitions[low];
+}
+
+/**
+ * Adds an offset to the runs of consecutive offsets seen within a partition. Offsets seen before are counted as
+ * duplicates.
+ *
+ * Exports list the offsets of a partition mostly in ascending order, thus the common case is extending the last run.
+ * Otherwise the run is looked up by binary search. Either way a new run has to be allocated only for a new gap.
+ */
+static void add_offset(struct partition_summary *partition_summary, uint64_t offset) {
+    struct offset_run *offset_runs = partition_summary->offset_runs;
+    const size_t offset_runs_len = partition_summary->offset_runs_len;
+
+    if (offset_runs_len > 0 && offset > offset_runs[offset_runs_len - 1].last) {
+        if (offset == offset_runs[offset_runs_len - 1].last + 1) {
+            offset_runs[offset_runs_len - 1].last = offset;
+        } else {
+            insert_offset_run(partition_summary, offset_runs_len, offset);
+        }
+        return;
+    }
+
+    // find the first run starting after offset
+    size_t low = 0;
+    size_t high = offset_runs_len;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (offset_runs[middle].first <= offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    struct offset_run *previous = low > 0 ? &offset_runs[low - 1] : NULL;
+    struct offset_run *next = low < offset_runs_len ? &offset_runs[low] : NULL;
+
+    if (previous != NULL && offset <= previous->last) {
+        partition_summary->duplicate_offsets++;
+        return;
+    }
+
+    const int extends_previous = previous != NULL && offset == previous->last + 1;
+    const int extends_next = next != NULL && offset + 1 == next->first;
+
+    if (extends_previous && extends_next) {
+        // offset closes the gap between both runs - merge them
+        previous->last = next->last;
+        memmove(next, next + 1, sizeof(struct offset_run) * (offset_runs_len - low - 1));
+        partition_summary->offset_runs_len--;
+    } else if (extends_previous) {
+        previous->last = offset;
+    } else if (extends_next) {
+        next->first = offset;
+    } else {
+        insert_offset_run(partition_summary, low, offset);
+    }
+}
+
+static void insert_offset_run(struct partition_summary *partition_summary, size_t idx, uint64_t offset) {
+    if (partition_summary->offset_runs_len == partition_summary->offset_runs_capacity) {
+        const size_t offset_runs_capacity = partition_summary->offset_runs_capacity < 16
+                                            ? 16 : partition_summary->offset_runs_capacity * 2;
+
+        struct offset_run *offset_runs = realloc(partition_summary->offset_runs,
+                                                 sizeof(struct offset_run) * offset_runs_capacity);
+        if (offset_runs == NULL) {
+            fprintf(stderr, "Failed to allocate memory for offset runs\n");
+            exit(EXIT_FAILURE);
+        }
+
+        partition_summary->offset_runs = offset_runs;
+        partition_summary->offset_runs_capacity = offset_runs_capacity;
+    }
+
+    struct offset_run *offset_runs = partition_summary->offset_runs;
+    memmove(&offset_runs[idx + 1], &offset_runs[idx],
+            sizeof(struct offset_run) * (partition_summary->offset_runs_len - idx));
+    partition_summary->offset_runs_len++;
+
+    offset_runs[idx].first = offset;
+    offset_runs[idx].last = offset;
+}
+
+/**
+ * 64-bit FNV-1a followed by the MurmurHash3 finalizer. HyperLogLog relies on well distributed high bits which FNV-1a
+ * alone does not provide for short keys.
+ */
+static uint64_t hash_key(const char *line, struct field_span span) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t idx = span.start; idx < span.end; idx++) {
+        hash ^= (unsigned char) line[idx];
+        hash *= 0x100000001b3ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/**
+ * Adds a key to the HyperLogLog sketch: the first HLL_PRECISION bits of its hash select a register, which keeps the
+ * maximum position of the first 1-bit seen in the remaining bits.
+ */
+static void add_key(struct export_summary *summary, const char *line, struct field_span span) {
+    const uint64_t hash = hash_key(line, span);
+    const size_t idx = hash >> (64 - HLL_PRECISION);
+    const uint64_t remaining_bits = hash << HLL_PRECISION;
+    const uint8_t rank = remaining_bits == 0
+                         ? 64 - HLL_PRECISION + 1
+                         : __builtin_clzll(remaining_bits) + 1;
+
+    if (rank > summary->key_registers[idx]) {
+        summary->key_registers[idx] = rank;
+    }
+}
+
+/**
+ * HyperLogLog estimate (Flajolet et al.) with linear counting for small cardinalities.
+ */
+static double estimate_key_cardinality(const struct export_summary *summary) {
+    const double m = HLL_REGISTERS;
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double sum = 0.0;
+    size_t empty_registers = 0;
+
+    for (size_t idx = 0; idx < HLL_REGISTERS; idx++) {
+        sum += ldexp(1.0, -summary->key_registers[idx]);
+        if (summary->key_registers[idx] == 0) {
+            empty_registers++;
+        }
+    }
+
+    const double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && empty_registers > 0) {
+        return m * log(m / (double) empty_registers);
+    }
+    return estimate;
+}
+
+/**
+ * Value sizes are counted in a log-linear histogram: sizes below 2^VALUE_SIZE_SUB_BITS get a bucket of their own, every
+ * larger power of two range is split into 2^VALUE_SIZE_SUB_BITS buckets of equal width.
+ */
+static size_t value_size_bucket(size_t value_size) {
+    if (value_size < (1 << VALUE_SIZE_SUB_BITS)) {
+        return value_size;
+    }
+
+    const unsigned int shift = 63 - __builtin_clzll(value_size) - VALUE_SIZE_SUB_BITS;
+    const size_t sub_bucket = (value_size >> shift) & ((1 << VALUE_SIZE_SUB_BITS) - 1);
+
+    return ((shift + 1) << VALUE_SIZE_SUB_BITS) + sub_bucket;
+}
+
+/**
+ * Returns the (upper bound of the bucket of the) value size below or at which percentile percent of all values are.
+ */
+static size_t value_size_percentile(const struct export_summary *summary, double percentile) {
+    if (summary->records == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = (uint64_t) ceil(percentile / 100.0 * (double) summary->records);
+    uint64_t count = 0;
+
+    for (size_t bucket = 0; bucket < VALUE_SIZE_BUCKETS; bucket++) {
+        count += summary->value_sizes[bucket];
+        if (count < rank) {
+            continue;
+        }
+
+        if (bucket < (1 << VALUE_SIZE_SUB_BITS)) {
+            return bucket;
+        }
+
+        const unsigned int shift = (bucket >> VALUE_SIZE_SUB_BITS) - 1;
+        const size_t sub_bucket = bucket & ((1 << VALUE_SIZE_SUB_BITS) - 1);
+        const size_t upper_bound = ((((size_t) 1 << VALUE_SIZE_SUB_BITS) + sub_bucket + 1) << shift) - 1;
+
+        return upper_bound < summary->value_size_max ? upper_bound : summary->value_size_max;
+    }
+
+    return summary->value_size_max;
+}
@@ -0,0 +1,65 @@
+#ifndef UNPACK_SUMMARY_H
+#define UNPACK_SUMMARY_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "unpack.h"
+
+#define TIMESTAMP_MAX_LEN 48
+
+/* HyperLogLog precision: 2^14 registers, standard error of about 0.8% */
+#define HLL_PRECISION 14
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+
+/* value sizes below 2^VALUE_SIZE_SUB_BITS are counted exactly, larger ones within 1/2^VALUE_SIZE_SUB_BITS */
+#define VALUE_SIZE_SUB_BITS 4
+#define VALUE_SIZE_BUCKETS ((64 - VALUE_SIZE_SUB_BITS + 1) << VALUE_SIZE_SUB_BITS)
+
+/* consecutive offsets first..last (both inclusive) seen within a partition */
+struct offset_run {
+    uint64_t first;
+    uint64_t last;
+};
+
+struct partition_summary {
+    uint64_t partition;
+    uint64_t records;
+    uint64_t duplicate_offsets;
+    struct offset_run *offset_runs; /* sorted, neither overlapping nor adjacent */
+    size_t offset_runs_len;
+    size_t offset_runs_capacity;
+    char timestamp_min[TIMESTAMP_MAX_LEN];
+    char timestamp_max[TIMESTAMP_MAX_LEN];
+};
+
+struct export_summary {
+    struct partition_summary *partitions; /* sorted by partition number */
+    size_t partitions_len;
+    size_t partitions_capacity;
+
+    uint64_t records;
+    uint64_t skipped_lines;
+    uint64_t invalid_timestamps;
+    char timestamp_min[TIMESTAMP_MAX_LEN];
+    char timestamp_max[TIMESTAMP_MAX_LEN];
+
+    uint8_t key_registers[HLL_REGISTERS];
+
+    uint64_t value_sizes[VALUE_SIZE_BUCKETS];
+    size_t value_size_max;
+};
+
+void summarize_file(FILE *fp);
+
+void summarize_record_line(const char *line,
+                           size_t line_len,
+                           const struct export_metadata *metadata,
+                           void *context
+);
+
+void print_summary(const struct export_summary *summary,
+                   const struct export_metadata *metadata
+);
+
+#endif // UNPACK_SUMMARY_H
@@ -102,6 +102,36 @@ size_t find_index_of_substring_in_string_beginning_from(
     return idx_of_substring_in_string;
 }
 
+/**
+ * Returns index of first occurrence of c in string or -1 if not available.
+ *
+ * Unlike find_index_of_substring_in_string_beginning_from() the length of string has to be known by the caller, which
+ * spares us scanning string for its terminating \0 on every call.
+ *
+ * @param string
+ * @param string_len - length of string (as returned by strlen())
+ * @param c - the char to look for
+ * @param begin_from - start searching for c in string beginning (inclusive) this position
+ * @return
+ */
+size_t find_index_of_char(
+        const char *string,
+        size_t string_len,
+        char c,
+        size_t begin_from
+) {
+    if (begin_from >= string_len) {
+        return -1;
+    }
+
+    const char *found = memchr(string + begin_from, c, string_len - begin_from);
+    if (found == NULL) {
+        return -1;
+    }
+
+    return found - string;
+}
+
 /**
  * Returns a copy the data between two delimiters from a given string. Delimiters are not included.
  *
@@ -16,6 +16,13 @@ size_t find_index_of_substring_in_string_beginning_from(
         size_t begin_from
 );
 
+size_t find_index_of_char(
+        const char *string,
+        size_t string_len,
+        char c,
+        size_t begin_from
+);
+
 int copy_text_between(
         const char *string,
         const char *left_delim,
@@ -19,19 +19,28 @@ const unsigned char SINGLE_QUOTE = '\''; // \x27
  * Read a topic reader export file and try to unpack all it's records, line by line.
  */
 void unpack_file(FILE *fp) {
+    struct export_metadata metadata = {0};
+
+    read_export_file(fp, &metadata, unpack_record_line, NULL);
+    free_export_metadata(&metadata);
+}
+
+/**
+ * Read a topic reader export file line by line. The five leading metadata lines are parsed into metadata, every
+ * following line long enough to carry a record is passed to handler (together with its length as returned by getline
+ * and the metadata parsed so far).
+ *
+ * Memory allocated for the fields of metadata has to be freed by the caller (see free_export_metadata()).
+ */
+void read_export_file(FILE *fp, struct export_metadata *metadata, record_handler handler, void *context) {
     char *line = NULL;
     size_t len = 0;
+    ssize_t line_len = 0;
     size_t line_number = 0;
     size_t minimum_length_of_valid_csv_lines = 8;
 
-    char *environment = NULL;
-    char *topic = NULL;
-    char *search_value = NULL;
-    char *time_from = NULL;
-    char *time_to = NULL;
-
     // man 3 getline: The buffer is null-terminated and includes the newline character, if one was found.
-    while ((getline(&line, &len, fp)) != -1) {
+    while ((line_len = getline(&line, &len, fp)) != -1) {
         line_number = line_number + 1;
 
         // unpack export metadata
@@ -41,7 +50,7 @@ void unpack_file(FILE *fp) {
                             line,
                             "environment: ",
                             "\n",
-                            &environment),
+                            &metadata->environment),
                     "Failed to extract environment from line 1.\n"
             );
 
@@ -51,7 +60,7 @@ void unpack_file(FILE *fp) {
                             line,
                             "topic      : ",
                             "\n",
-                            &topic
+                            &metadata->topic
                     ),
                     "Failed to extract topic from line 2.\n"
             );
@@ -61,7 +70,7 @@ void unpack_file(FILE *fp) {
                             line,
                             "searchValue: ",
                             "\n",
-                            &search_value
+                            &metadata->search_value
                     ),
                     "Failed to extract search_value from line 3.\n"
             );
@@ -71,7 +80,7 @@ void unpack_file(FILE *fp) {
                             line,
                             "timeFrom   : ",
                             "\n",
-                            &time_from
+                            &metadata->time_from
                     ), "Failed to extract time_from from line 4.\n"
             );
         } else if (line_number == 5) {
@@ -80,48 +89,69 @@ void unpack_file(FILE *fp) {
                             line,
                             "timeTo     : ",
                             "\n",
-                            &time_to
+                            &metadata->time_to
                     ), "Failed to extract time_to from line 5.\n"
             );
         } else if (line_number > 5) {
             // require all valid "csv" lines to have at least 8 chars (1,2,3,,\n)
-            if (strlen(line) >= minimum_length_of_valid_csv_lines) {
-                unpack_record(line, environment, topic);
+            if ((size_t) line_len >= minimum_length_of_valid_csv_lines) {
+                handler(line, (size_t) line_len, metadata, context);
             }
         }
     }
 
     FREE(line);
-    FREE(environment);
-    FREE(topic);
-    FREE(search_value);
-    FREE(time_from);
-    FREE(time_to);
 }
 
-void unpack_record(char *line, const char *environment, const char *topic) {
-    char *partition = NULL;
-    char *offset = NULL;
-    char *timestamp = NULL;
-    char *key = NULL;
-    char *value = NULL;
+void free_export_metadata(struct export_metadata *metadata) {
+    FREE(metadata->environment);
+    FREE(metadata->topic);
+    FREE(metadata->search_value);
+    FREE(metadata->time_from);
+    FREE(metadata->time_to);
+}
+
+void unpack_record_line(const char *line, size_t line_len, const struct export_metadata *metadata, void *context) {
+    unpack_record(line, line_len, metadata->environment, metadata->topic);
+}
 
+/**
+ * Locates the fields partition, offset, timestamp, key and value within a single record line without copying them.
+ *
+ * Every field is described by a start index (inclusive) and an end index (exclusive). Enclosing '' of key and value
+ * are not part of their field.
+ *
+ * @param line - the record line (may still carry its trailing \r\n)
+ * @param line_len - length of line as returned by strlen() or getline()
+ * @param fields - receives the located fields
+ *
+ * @return 0 on success, 1 if the line lacks one of the , delimiters in front of the value field
+ */
+int scan_record_fields(const char *line, size_t line_len, struct record_fields *fields) {
     size_t start_idx = 0; /* inclusive - should point to first char of content to be included */
     size_t end_idx = 0; /* exclusive - should point to the first char being excluded (after content) */
 
-    end_idx = find_index_of_substring_in_string_beginning_from(line, ",", start_idx);
-    partition = substr(line, start_idx, end_idx);
-    warn_on_empty_field(partition, "partition", line);
+    memset(fields, 0, sizeof(*fields));
+
+    if ((end_idx = find_index_of_char(line, line_len, ',', start_idx)) == -1) {
+        return 1;
+    }
+    fields->partition.start = start_idx;
+    fields->partition.end = end_idx;
 
     start_idx = end_idx + 1;
-    end_idx = find_index_of_substring_in_string_beginning_from(line, ",", start_idx);
-    offset = substr(line, start_idx, end_idx);
-    warn_on_empty_field(offset, "offset", line);
+    if ((end_idx = find_index_of_char(line, line_len, ',', start_idx)) == -1) {
+        return 1;
+    }
+    fields->offset.start = start_idx;
+    fields->offset.end = end_idx;
 
     start_idx = end_idx + 1;
-    end_idx = find_index_of_substring_in_string_beginning_from(line, ",", start_idx);
-    timestamp = substr(line, start_idx, end_idx);
-    warn_on_empty_field(timestamp, "timestamp", line);
+    if ((end_idx = find_index_of_char(line, line_len, ',', start_idx)) == -1) {
+        return 1;
+    }
+    fields->timestamp.start = start_idx;
+    fields->timestamp.end = end_idx;
 
     start_idx = end_idx + 1;
 
@@ -129,24 +159,40 @@ void unpack_record(char *line, const char *environment, const char *topic) {
     // We want the data within those '' but not those '' themselves.
     unsigned char field_start_char = line[start_idx];
 
-    /* extract key */
+    /* locate key */
     if (field_start_char == SINGLE_QUOTE) {
-        end_idx = find_index_of_substring_in_string_beginning_from(line, "',", start_idx);
-        // +1 to skip leading ', end doesn't require this due to subString already including ' before ,
-        key = substr(line, start_idx + 1, end_idx);
+        end_idx = start_idx;
+        do {
+            end_idx = find_index_of_char(line, line_len, SINGLE_QUOTE, end_idx + 1);
+        } while (end_idx != -1 && line[end_idx + 1] != ',');
+        if (end_idx == -1) {
+            return 1;
+        }
+        // +1 to skip leading ', end_idx already points to the ' before ,
+        fields->key.start = start_idx + 1;
+        fields->key.end = end_idx;
         start_idx = end_idx + 2; // + 2 because end points now to the beginning of "'," and not ","
     } else {
-        end_idx = find_index_of_substring_in_string_beginning_from(line, ",", start_idx);
-        key = substr(line, start_idx, end_idx);
+        if ((end_idx = find_index_of_char(line, line_len, ',', start_idx)) == -1) {
+            return 1;
+        }
+        fields->key.start = start_idx;
+        fields->key.end = end_idx;
         start_idx = end_idx + 1; // start of next field
     }
 
     field_start_char = line[start_idx];
 
-    /* extract value */
-    const size_t line_len = strlen_without_trailing_carriage_return_and_line_feed(line);
+    /* locate value */
+    fields->content_len = line_len;
+    if (fields->content_len > 0 && line[fields->content_len - 1] == '\n') {
+        fields->content_len--;
+    }
+    if (fields->content_len > 0 && line[fields->content_len - 1] == '\r') {
+        fields->content_len--;
+    }
 
-    end_idx = line_len;
+    end_idx = fields->content_len;
 
     if (field_start_char == SINGLE_QUOTE) {
         /* Ok, let's assume there is some closing ' as well - reverse search line for it */
@@ -155,32 +201,66 @@ void unpack_record(char *line, const char *environment, const char *topic) {
         }
         if (start_idx == end_idx) {
             // it seems value contains just a single ' but no ending '. Do not skip it, take it as it is.
-            value = substr(line, start_idx, start_idx + 1);
+            fields->value.start = start_idx;
+            fields->value.end = start_idx + 1;
         } else {
             // value seems to be enclosed within '' => include everything after the first ' up to (but excluding) the last '
-
-            // start_idx points now to the leading '. start_idx is inclusive, thus start + 1 skips the leading '
-            // end_idx points now to the trailing '. end_idx is exclusive, thus no + 1.
-            value = substr(line, start_idx + 1, end_idx);
-
-            // KNOWN BUG:
-            // For certain inputs it is know that we actually might cut off too much - leading to a wrong value.
-            // I do not really care about this except printing a warning in obvious cases. Maybe someone else cares?
-            // Example: '{"name":"pam's blog"}
-            if (line_len - end_idx > 2) {
-                fprintf(stdout,
-                        "Warning: Encountered unexpected position of token ' while parsing field value of record: "
-                        "environment=[%s], topic=[%s], partition=[%s], offset=[%s], timestamp=[%s], key=[%s], value=[%s], line=[%s]\n",
-                        environment, topic, partition, offset, timestamp, key, value, line
-                );
-            }
+            fields->value.start = start_idx + 1;
+            fields->value.end = end_idx;
+            fields->value_enclosed = 1;
         }
     } else { /* value field is not enclosed within '' */
-        value = substr(line, start_idx, end_idx);
+        fields->value.start = start_idx;
+        fields->value.end = end_idx;
+    }
+
+    return 0;
+}
+
+void unpack_record(const char *line, size_t line_len, const char *environment, const char *topic) {
+    char *partition = NULL;
+    char *offset = NULL;
+    char *timestamp = NULL;
+    char *key = NULL;
+    char *value = NULL;
+
+    struct record_fields fields;
+
+    if (scan_record_fields(line, line_len, &fields) != 0) {
+        fprintf(stderr,
+                "Warning: Encountered incomplete data while parsing line. Cannot unpack record into file."
+                "environment=[%s], topic=[%s], line=[%s]\n",
+                environment, topic, line
+        );
+        return;
+    }
+
+    partition = substr(line, fields.partition.start, fields.partition.end);
+    warn_on_empty_field(partition, "partition", line);
+
+    offset = substr(line, fields.offset.start, fields.offset.end);
+    warn_on_empty_field(offset, "offset", line);
+
+    timestamp = substr(line, fields.timestamp.start, fields.timestamp.end);
+    warn_on_empty_field(timestamp, "timestamp", line);
+
+    key = substr(line, fields.key.start, fields.key.end);
+    value = substr(line, fields.value.start, fields.value.end);
+
+    // KNOWN BUG:
+    // For certain inputs it is know that we actually might cut off too much - leading to a wrong value.
+    // I do not really care about this except printing a warning in obvious cases. Maybe someone else cares?
+    // Example: '{"name":"pam's blog"}
+    if (fields.value_enclosed && fields.content_len - fields.value.end > 2) {
+        fprintf(stdout,
+                "Warning: Encountered unexpected position of token ' while parsing field value of record: "
+                "environment=[%s], topic=[%s], partition=[%s], offset=[%s], timestamp=[%s], key=[%s], value=[%s], line=[%s]\n",
+                environment, topic, partition, offset, timestamp, key, value, line
+        );
     }
 
     DF("environment=[%s], topic=[%s], partition=[%s], offset=[%s], timestamp=[%s], key=[%s], value=[%s], line=[%s], start_idx=[%zu], end_idx=[%zu]",
-       environment, topic, partition, offset, timestamp, key, value, line, start_idx, end_idx);
+       environment, topic, partition, offset, timestamp, key, value, line, fields.value.start, fields.value.end);
 
     if (environment != NULL && topic != NULL && partition != NULL && offset != NULL) {
         write_record_file(environment, topic, partition, offset, timestamp, key, value);
@@ -198,7 +278,6 @@ void unpack_record(char *line, const char *environment, const char *topic) {
     FREE(value);
 }
 
-
 void write_record_file(const char *environment, const char *topic, const char *partition, const char *offset,
                        const char *timestamp, const char *key, const char *value) {
 
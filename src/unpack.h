@@ -5,7 +5,57 @@
 
 #include <stdio.h>
 
-void unpack_record(char *line,
+struct export_metadata {
+    char *environment;
+    char *topic;
+    char *search_value;
+    char *time_from;
+    char *time_to;
+};
+
+/* start (inclusive) and end (exclusive) index of a field within a record line */
+struct field_span {
+    size_t start;
+    size_t end;
+};
+
+struct record_fields {
+    struct field_span partition;
+    struct field_span offset;
+    struct field_span timestamp;
+    struct field_span key;
+    struct field_span value;
+    size_t content_len; /* length of the line without trailing \r\n */
+    int value_enclosed; /* 1 if value was enclosed within '' */
+};
+
+typedef void (*record_handler)(const char *line,
+                               size_t line_len,
+                               const struct export_metadata *metadata,
+                               void *context
+);
+
+void read_export_file(FILE *fp,
+                      struct export_metadata *metadata,
+                      record_handler handler,
+                      void *context
+);
+
+void free_export_metadata(struct export_metadata *metadata);
+
+int scan_record_fields(const char *line,
+                       size_t line_len,
+                       struct record_fields *fields
+);
+
+void unpack_record_line(const char *line,
+                        size_t line_len,
+                        const struct export_metadata *metadata,
+                        void *context
+);
+
+void unpack_record(const char *line,
+                   size_t line_len,
                    const char *environment,
                    const char *topic
 );